@@ -41,7 +41,7 @@ static const int8_t numerical_symbols[] = {
 #define MINUS 10
 #define SPACE 11
 
-static const int8_t ascii_symbols[] = {
+static const uint8_t ascii_symbols[128] = {
     //NUL   SOH   STX   ETX   EOT   ENQ   ACK   BEL   BS    HT    LF    VT
     0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
     //FF    CR    SO    SI    DLE   DC1   DC2   DC3   DC4   NAK   SYN   ETB
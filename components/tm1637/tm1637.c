@@ -15,20 +15,50 @@
 
 #include "freertos/FreeRTOS.h"
 #include "rom/ets_sys.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
+#include "soc/soc_caps.h"
 
 #include "tm1637.h"
+#include "tm1637_priv.h"
+#include "tm1637_font.h"
 #include "symbols.h"
 
 #define TM1637_ADDR_AUTO  0x40
 #define TM1637_ADDR_FIXED 0x44
 #define TM1637_AUTO_DELAY 300000
+#define TM1637_BRIGHTNESS_UNKNOWN 0xFF
+#define TM1637_RTC_MAGIC 0x16371637
+
+#if CONFIG_TM1637_RTC_SLOTS > 0
+// Shadow of the display kept across deep sleep
+typedef struct {
+	uint32_t magic;
+	gpio_num_t pin_clk;
+	gpio_num_t pin_dta;
+	uint8_t ram[6];
+	uint8_t ram_valid;
+	uint8_t ram_brightness;
+	uint8_t brightness;
+} tm1637_rtc_t;
+
+static RTC_DATA_ATTR tm1637_rtc_t rtc_state[CONFIG_TM1637_RTC_SLOTS];
+#endif
 
 static void tm1637_start(tm1637_led_t * led);
 static void tm1637_stop(tm1637_led_t * led);
 static void tm1637_send_byte(tm1637_led_t * led, uint8_t byte);
 static void tm1637_delay();
+static void tm1637_release_hold(gpio_num_t pin_clk, gpio_num_t pin_data);
+static void tm1637_send_auto(tm1637_led_t * led, const int address, const uint8_t *data, const int data_length);
+static bool tm1637_ram_equal(tm1637_led_t * led, const int address, const uint8_t *data, const int data_length);
+static void tm1637_ram_update(tm1637_led_t * led, const int address, const uint8_t *data, const int data_length);
+static void tm1637_set_number_digits(tm1637_led_t * led, int32_t number, bool lead_zero, const uint16_t dot_position);
+#if CONFIG_TM1637_STATS && CONFIG_TM1637_STATS_DUMP_INTERVAL > 0
+static void tm1637_stats_dump_timer(void * arg);
+#endif
 
 #if CONFIG_TM1637_4_SEGMENT
 int segment_idx[6] = {-1, -1, 0, 1, 2, 3};
@@ -63,6 +93,7 @@ void tm1637_stop(tm1637_led_t * led)
 	tm1637_delay();
 	gpio_set_level(led->m_pin_dta, 1);
 	tm1637_delay();
+	TM1637_STATS_ADD(led, transactions, 1);
 }
 
 void tm1637_send_byte(tm1637_led_t * led, uint8_t byte)
@@ -87,9 +118,11 @@ void tm1637_send_byte(tm1637_led_t * led, uint8_t byte)
 	tm1637_delay();
 	gpio_set_level(led->m_pin_clk, 1);
 	tm1637_delay();
+	TM1637_STATS_ADD(led, nacks, gpio_get_level(led->m_pin_dta)); // DIO still high is NACK
 	gpio_set_level(led->m_pin_clk, 0); // TM1637 ends ACK (releasing DIO)
 	tm1637_delay();
 	gpio_set_direction(led->m_pin_dta, GPIO_MODE_OUTPUT);
+	TM1637_STATS_ADD(led, bytes, 1);
 }
 
 void tm1637_delay()
@@ -98,9 +131,72 @@ void tm1637_delay()
 	ets_delay_us(1);
 }
 
-// PUBLIC PART:
+// Pads may still be held at bus idle (both HIGH) by tm1637_suspend, so
+// the pins are configured behind the hold and released without a glitch
+void tm1637_release_hold(gpio_num_t pin_clk, gpio_num_t pin_data)
+{
+	gpio_config_t io_conf = {
+		.pin_bit_mask = (1ULL << pin_clk) | (1ULL << pin_data),
+		.mode = GPIO_MODE_OUTPUT,
+		.pull_up_en = GPIO_PULLUP_DISABLE,
+		.pull_down_en = GPIO_PULLDOWN_DISABLE,
+		.intr_type = GPIO_INTR_DISABLE,
+	};
+	gpio_set_level(pin_clk, 1);
+	gpio_set_level(pin_data, 1);
+	gpio_config(&io_conf);
+	gpio_hold_dis(pin_clk);
+	gpio_hold_dis(pin_data);
+#if !SOC_GPIO_SUPPORT_HOLD_SINGLE_IO_IN_DSLP
+	gpio_deep_sleep_hold_dis();
+#endif
+}
 
-tm1637_led_t * tm1637_init(gpio_num_t pin_clk, gpio_num_t pin_data) {
+// Automatic address adding mode from address
+void tm1637_send_auto(tm1637_led_t * led, const int address, const uint8_t *data, const int data_length)
+{
+	tm1637_start(led);
+	tm1637_send_byte(led, TM1637_ADDR_AUTO);
+	tm1637_stop(led);
+	tm1637_start(led);
+	tm1637_send_byte(led, address | 0xc0);
+	for (int i=0;i<data_length;i++) {
+		tm1637_send_byte(led, data[i]);
+	}
+	tm1637_stop(led);
+	tm1637_start(led);
+	tm1637_send_byte(led, led->m_brightness | 0x88);
+	tm1637_stop(led);
+
+	// Display RAM has 6 addresses, bytes past them are not shadowed
+	int ram_length = data_length;
+	if (address + ram_length > (int)sizeof(led->m_ram)) ram_length = (int)sizeof(led->m_ram) - address;
+	if (ram_length > 0) tm1637_ram_update(led, address, data, ram_length);
+}
+
+// True when the display already shows data at these addresses
+// with the current brightness, addresses must be within 0..5
+bool tm1637_ram_equal(tm1637_led_t * led, const int address, const uint8_t *data, const int data_length)
+{
+	if (led->m_ram_brightness != led->m_brightness) return false;
+	for (int i=0;i<data_length;i++) {
+		if ((led->m_ram_valid & (1 << (address+i))) == 0) return false;
+		if (led->m_ram[address+i] != data[i]) return false;
+	}
+	return true;
+}
+
+void tm1637_ram_update(tm1637_led_t * led, const int address, const uint8_t *data, const int data_length)
+{
+	for (int i=0;i<data_length;i++) {
+		led->m_ram[address+i] = data[i];
+		led->m_ram_valid |= (1 << (address+i));
+	}
+	led->m_ram_brightness = led->m_brightness;
+}
+
+static tm1637_led_t * tm1637_create(gpio_num_t pin_clk, gpio_num_t pin_data)
+{
 	tm1637_led_t * led = (tm1637_led_t *) malloc(sizeof(tm1637_led_t));
 	if (led == NULL) {
 		ESP_LOGE(__FUNCTION__,"malloc fail");
@@ -116,6 +212,34 @@ tm1637_led_t * tm1637_init(gpio_num_t pin_clk, gpio_num_t pin_data) {
 	led->m_pin_dta = pin_data;
 	//led->m_brightness = 0x07;
 	led->m_brightness = CONFIG_TM1637_BRIGHTNESS;;
+	led->m_ram_valid = 0;
+	led->m_ram_brightness = TM1637_BRIGHTNESS_UNKNOWN;
+#if CONFIG_TM1637_STATS
+	portMUX_INITIALIZE(&led->m_stats_mux);
+#endif
+	tm1637_reset_stats(led);
+
+#if CONFIG_TM1637_STATS && CONFIG_TM1637_STATS_DUMP_INTERVAL > 0
+	const esp_timer_create_args_t timer_args = {
+		.callback = tm1637_stats_dump_timer,
+		.arg = led,
+		.name = "tm1637_stats",
+	};
+	esp_timer_handle_t timer;
+	if (esp_timer_create(&timer_args, &timer) == ESP_OK) {
+		esp_timer_start_periodic(timer, (uint64_t)CONFIG_TM1637_STATS_DUMP_INTERVAL * 1000000);
+	} else {
+		ESP_LOGE(__FUNCTION__,"esp_timer_create fail");
+	}
+#endif
+	return led;
+}
+
+// PUBLIC PART:
+
+tm1637_led_t * tm1637_init(gpio_num_t pin_clk, gpio_num_t pin_data) {
+	tm1637_led_t * led = tm1637_create(pin_clk, pin_data);
+	if (led == NULL) return NULL;
 
 	gpio_reset_pin(pin_clk);
 	gpio_reset_pin(pin_data);
@@ -131,6 +255,83 @@ tm1637_led_t * tm1637_init(gpio_num_t pin_clk, gpio_num_t pin_data) {
 	return led;
 }
 
+// The module keeps its RAM through deep sleep, so the shadow of it is
+// kept in RTC memory and the bus is not touched on wake up
+tm1637_led_t * tm1637_resume(gpio_num_t pin_clk, gpio_num_t pin_data)
+{
+	// Release the hold of tm1637_suspend on every path, even when no state
+	// was saved, so tm1637_init never toggles latched pins
+	tm1637_release_hold(pin_clk, pin_data);
+
+#if CONFIG_TM1637_RTC_SLOTS > 0
+	tm1637_rtc_t * slot = NULL;
+	for (int i=0; i<CONFIG_TM1637_RTC_SLOTS; i++) {
+		if (rtc_state[i].magic == TM1637_RTC_MAGIC && rtc_state[i].pin_clk == pin_clk && rtc_state[i].pin_dta == pin_data) {
+			slot = &rtc_state[i];
+		}
+	}
+	if (slot == NULL) return tm1637_init(pin_clk, pin_data); // Cold boot
+
+	tm1637_led_t * led = tm1637_create(pin_clk, pin_data);
+	if (led == NULL) return NULL;
+	memcpy(led->m_ram, slot->ram, sizeof(led->m_ram));
+	led->m_ram_valid = slot->ram_valid;
+	led->m_ram_brightness = slot->ram_brightness;
+	led->m_brightness = slot->brightness;
+	slot->magic = 0;
+	return led;
+#else
+	return tm1637_init(pin_clk, pin_data);
+#endif
+}
+
+bool tm1637_suspend(tm1637_led_t * led)
+{
+#if CONFIG_TM1637_RTC_SLOTS > 0
+	tm1637_rtc_t * slot = NULL;
+	for (int i=0; i<CONFIG_TM1637_RTC_SLOTS; i++) {
+		if (rtc_state[i].magic == TM1637_RTC_MAGIC && rtc_state[i].pin_clk == led->m_pin_clk && rtc_state[i].pin_dta == led->m_pin_dta) {
+			slot = &rtc_state[i];
+			break;
+		}
+		if (slot == NULL && rtc_state[i].magic != TM1637_RTC_MAGIC) slot = &rtc_state[i];
+	}
+	if (slot == NULL) {
+		ESP_LOGE(__FUNCTION__,"no free RTC slot, increase CONFIG_TM1637_RTC_SLOTS");
+		return false;
+	}
+
+	// Keep bus idle (both HIGH) while the chip sleeps
+	gpio_set_level(led->m_pin_clk, 1);
+	gpio_set_level(led->m_pin_dta, 1);
+	esp_err_t ret = gpio_hold_en(led->m_pin_clk);
+	if (ret == ESP_OK) {
+		ret = gpio_hold_en(led->m_pin_dta);
+		if (ret != ESP_OK) gpio_hold_dis(led->m_pin_clk);
+	}
+	if (ret != ESP_OK) {
+		ESP_LOGE(__FUNCTION__,"gpio_hold_en fail %d", ret);
+		return false;
+	}
+#if !SOC_GPIO_SUPPORT_HOLD_SINGLE_IO_IN_DSLP
+	// Digital pads of this target only hold in deep sleep all together
+	gpio_deep_sleep_hold_en();
+#endif
+
+	slot->pin_clk = led->m_pin_clk;
+	slot->pin_dta = led->m_pin_dta;
+	memcpy(slot->ram, led->m_ram, sizeof(slot->ram));
+	slot->ram_valid = led->m_ram_valid;
+	slot->ram_brightness = led->m_ram_brightness;
+	slot->brightness = led->m_brightness;
+	slot->magic = TM1637_RTC_MAGIC;
+	return true;
+#else
+	ESP_LOGW(__FUNCTION__,"CONFIG_TM1637_RTC_SLOTS is 0");
+	return false;
+#endif
+}
+
 void tm1637_set_brightness(tm1637_led_t * led, uint8_t level)
 {
 	if (level > 0x07) { level = 0x07; } // Check max level
@@ -139,83 +340,55 @@ void tm1637_set_brightness(tm1637_led_t * led, uint8_t level)
 
 void tm1637_set_segment_ascii(tm1637_led_t * led, char * text)
 {
-	char _text[7];
-	memset(_text, 0x20, 6);
-	int textLen = strlen(text);
-	strcpy(&_text[led->segment_max-textLen], text);
+	TM1637_STATS_BEGIN();
+	const char * p = text;
+	uint32_t c;
+	int textLen = tm1637_utf8_length(text);
 
 	if (textLen <= led->segment_max) {
 		// show fix segment
 		for (int i=0;i<led->segment_max;i++) {
-			int c = _text[i];
-			uint8_t seg_data = ascii_symbols[c];
-			//printf("text[%d]=%d seg_data=0x%x\n", i, c, seg_data);
+			uint8_t seg_data = 0;
+			if (i >= led->segment_max-textLen) {
+				c = tm1637_utf8_next(&p);
+				seg_data = tm1637_font_glyph(c);
+			}
+			//printf("text[%d]=%"PRIu32" seg_data=0x%x\n", i, c, seg_data);
 			tm1637_set_segment_fixed(led, led->segment_idx[i+led->segment_start], seg_data);
 		}
 	} else {
 		// show sliding segment
-		if (led->segment_max == 4) {
-			uint8_t segments4[4] = {0,0,0,0};
-			for (int i=0;i<strlen(text);i++) {
-				segments4[0] = segments4[1];
-				segments4[1] = segments4[2];
-				segments4[2] = segments4[3];
-				int c = text[i];
-				segments4[3] = ascii_symbols[c];
-				tm1637_set_segment_auto(led, segments4, 4);
-				//ets_delay_us(TM1637_AUTO_DELAY);
-				vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
-			}
-			for (int i=0;i<4;i++) {
-				segments4[0] = segments4[1];
-				segments4[1] = segments4[2];
-				segments4[2] = segments4[3];
-				segments4[3] = 0;
-				tm1637_set_segment_auto(led, segments4, 4);
-				//ets_delay_us(TM1637_AUTO_DELAY);
-				vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
-			}
-		} else {
-			uint8_t segments6[6] = {0,0,0,0,0,0};
-			for (int i=0;i<strlen(text);i++) {
-				segments6[2] = segments6[1];
-				segments6[1] = segments6[0];
-				segments6[0] = segments6[5];
-				segments6[5] = segments6[4];
-				segments6[4] = segments6[3];
-				int c = text[i];
-				segments6[3] = ascii_symbols[c];
-				tm1637_set_segment_auto(led, segments6, 6);
-				//ets_delay_us(TM1637_AUTO_DELAY);
-				vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
-			}
-			for (int i=0;i<6;i++) {
-				segments6[2] = segments6[1];
-				segments6[1] = segments6[0];
-				segments6[0] = segments6[5];
-				segments6[5] = segments6[4];
-				segments6[4] = segments6[3];
-				segments6[3] = 0;
-				tm1637_set_segment_auto(led, segments6, 6);
-				//ets_delay_us(TM1637_AUTO_DELAY);
-				vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
-			}
+		uint8_t frame[6] = {0,0,0,0,0,0};
+		int last = led->segment_max - 1;
+		while ((c = tm1637_utf8_next(&p)) != 0) {
+			memmove(frame, &frame[1], last);
+			frame[last] = tm1637_font_glyph(c);
+			tm1637_set_segment_frame(led, frame);
+			//ets_delay_us(TM1637_AUTO_DELAY);
+			vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
+		}
+		for (int i=0;i<led->segment_max;i++) {
+			memmove(frame, &frame[1], last);
+			frame[last] = 0;
+			tm1637_set_segment_frame(led, frame);
+			//ets_delay_us(TM1637_AUTO_DELAY);
+			vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
 		}
 	}
+	TM1637_STATS_END(led, TM1637_API_SET_SEGMENT_ASCII);
 }
 
 // ets_delay_us causes WatchDog alert.
 void tm1637_set_segment_ascii_with_time(tm1637_led_t * led, char * text, const uint16_t dot_position, int time)
 {
-	char _text[5];
-	int _text_length = strlen(text);
-	memset(_text, 0, sizeof(_text));
-	if (_text_length == 4) {
-		strcpy(_text, text);
-	} else if (_text_length < 4) {
-		memcpy(&_text[4-_text_length], text, _text_length);
-	} else {
-		memcpy(_text, text, 4);
+	TM1637_STATS_BEGIN();
+	// Right aligned, extra characters are cut
+	uint8_t glyphs[6] = {0,0,0,0,0,0};
+	const char * p = text;
+	int textLen = tm1637_utf8_length(text);
+	if (textLen > led->segment_max) textLen = led->segment_max;
+	for (int i=led->segment_max-textLen; i<led->segment_max; i++) {
+		glyphs[i] = tm1637_font_glyph(tm1637_utf8_next(&p));
 	}
 
 	for (int i=led->segment_start; i<6; i++) {
@@ -224,14 +397,13 @@ void tm1637_set_segment_ascii_with_time(tm1637_led_t * led, char * text, const u
 
 	uint8_t dot_mask = 0x01;
 	for (int i=(led->segment_max-1); i>=0; i--) {
-		int c = text[i];
-		uint8_t seg_data = ascii_symbols[c];
+		uint8_t seg_data = glyphs[i];
 		// Find the lower half segment(segment=c/d/e/g)
 		seg_data = seg_data & 0x5c; // 0b0101-1100
 		tm1637_set_segment_fixed(led, led->segment_idx[i+led->segment_start], seg_data);
 		//ets_delay_us(TM1637_AUTO_DELAY);
 		vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
-		seg_data = ascii_symbols[c];
+		seg_data = glyphs[i];
 		//printf("seg_data=0x%x dot_position=0x%x dot_mask=0x%x\n", seg_data, dot_position, dot_mask);
 		if (dot_position & dot_mask) seg_data |= 0x80; // Set DOT segment flag
 		//printf("seg_data=0x%x\n", seg_data);
@@ -244,8 +416,7 @@ void tm1637_set_segment_ascii_with_time(tm1637_led_t * led, char * text, const u
 	//ets_delay_us(time*1000);
 	vTaskDelay(pdMS_TO_TICKS(time));
 	for (int i=(led->segment_max-1); i>=0; i--) {
-		int c = text[i];
-		uint8_t seg_data = ascii_symbols[c];
+		uint8_t seg_data = glyphs[i];
 		// Find the upper half segment(segment=a/b/f/g)
 		seg_data = seg_data & 0x63; // 0b0110-0011
 		tm1637_set_segment_fixed(led, led->segment_idx[i+led->segment_start], seg_data);
@@ -255,6 +426,7 @@ void tm1637_set_segment_ascii_with_time(tm1637_led_t * led, char * text, const u
 		//ets_delay_us(TM1637_AUTO_DELAY);
 		vTaskDelay(pdMS_TO_TICKS(TM1637_AUTO_DELAY/1000));
 	}
+	TM1637_STATS_END(led, TM1637_API_SET_SEGMENT_ASCII_WITH_TIME);
 }
 
 // Fix address mode
@@ -263,7 +435,13 @@ void tm1637_set_segment_ascii_with_time(tm1637_led_t * led, char * text, const u
 void tm1637_set_segment_fixed(tm1637_led_t * led, const int8_t segment_idx, const uint8_t data)
 {
 	if (segment_idx < 0) return;
+	const bool shadowed = segment_idx < (int)sizeof(led->m_ram);
+	if (shadowed && tm1637_ram_equal(led, segment_idx, &data, 1)) {
+		TM1637_STATS_ADD(led, elided, 1);
+		return;
+	}
 
+	TM1637_STATS_BEGIN();
 	tm1637_start(led);
 	tm1637_send_byte(led, TM1637_ADDR_FIXED);
 	tm1637_stop(led);
@@ -274,6 +452,8 @@ void tm1637_set_segment_fixed(tm1637_led_t * led, const int8_t segment_idx, cons
 	tm1637_start(led);
 	tm1637_send_byte(led, led->m_brightness | 0x88);
 	tm1637_stop(led);
+	if (shadowed) tm1637_ram_update(led, segment_idx, &data, 1);
+	TM1637_STATS_END(led, TM1637_API_SET_SEGMENT_FIXED);
 }
 
 // Automatic address adding mode
@@ -281,18 +461,33 @@ void tm1637_set_segment_fixed(tm1637_led_t * led, const int8_t segment_idx, cons
 // [Set data][Set address][Display data1][Display data2][Display data3][Display data4][Control display]
 void tm1637_set_segment_auto(tm1637_led_t * led, const uint8_t *data, const int data_length)
 {
-	tm1637_start(led);
-	tm1637_send_byte(led, TM1637_ADDR_AUTO);
-	tm1637_stop(led);
-	tm1637_start(led);
-	tm1637_send_byte(led, 0xc0);
-	for (int i=0;i<data_length;i++) {
-		tm1637_send_byte(led, data[i]);
+	TM1637_STATS_BEGIN();
+	tm1637_send_auto(led, 0, data, data_length);
+	TM1637_STATS_END(led, TM1637_API_SET_SEGMENT_AUTO);
+}
+
+// Digits are given from left to right and are reordered into
+// display addresses. Only the address range that differs from the
+// display RAM is written, with one burst
+void tm1637_set_segment_frame(tm1637_led_t * led, const uint8_t *frame)
+{
+	uint8_t data[6] = {0,0,0,0,0,0};
+	for (int i=0;i<led->segment_max;i++) {
+		data[led->segment_idx[i+led->segment_start]] = frame[i];
 	}
-	tm1637_stop(led);
-	tm1637_start(led);
-	tm1637_send_byte(led, led->m_brightness | 0x88);
-	tm1637_stop(led);
+
+	int first = 0;
+	int last = led->segment_max - 1;
+	while (first <= last && tm1637_ram_equal(led, first, &data[first], 1)) first++;
+	while (last > first && tm1637_ram_equal(led, last, &data[last], 1)) last--;
+	if (first > last) {
+		TM1637_STATS_ADD(led, elided, 1);
+		return;
+	}
+
+	TM1637_STATS_BEGIN();
+	tm1637_send_auto(led, first, &data[first], last - first + 1);
+	TM1637_STATS_END(led, TM1637_API_SET_SEGMENT_FRAME);
 }
 
 void tm1637_set_segment_number(tm1637_led_t * led, const int8_t segment_idx, const uint8_t num, const bool dot)
@@ -300,6 +495,7 @@ void tm1637_set_segment_number(tm1637_led_t * led, const int8_t segment_idx, con
 	uint8_t seg_data = 0x00;
 
 	if (segment_idx < 0) return;
+	TM1637_STATS_BEGIN();
 	if (num < (sizeof(numerical_symbols)/sizeof(numerical_symbols[0]))) {
 		seg_data = numerical_symbols[num]; // Select proper segment image
 	}
@@ -309,9 +505,17 @@ void tm1637_set_segment_number(tm1637_led_t * led, const int8_t segment_idx, con
 	}
 
 	tm1637_set_segment_fixed(led, segment_idx, seg_data);
+	TM1637_STATS_END(led, TM1637_API_SET_SEGMENT_NUMBER);
 }
 
 void tm1637_set_number(tm1637_led_t * led, int32_t number, bool lead_zero, const uint16_t dot_position)
+{
+	TM1637_STATS_BEGIN();
+	tm1637_set_number_digits(led, number, lead_zero, dot_position);
+	TM1637_STATS_END(led, TM1637_API_SET_NUMBER);
+}
+
+static void tm1637_set_number_digits(tm1637_led_t * led, int32_t number, bool lead_zero, const uint16_t dot_position)
 {
 	int32_t _number = abs(number);
 
@@ -444,3 +648,93 @@ void tm1637_set_number(tm1637_led_t * led, int32_t number, bool lead_zero, const
 		}
 	}
 }
+
+#if CONFIG_TM1637_STATS
+static const char * tm1637_api_name[TM1637_API_MAX] = {
+	"set_segment_fixed",
+	"set_segment_auto",
+	"set_segment_frame",
+	"set_segment_number",
+	"set_number",
+	"set_segment_ascii",
+	"set_segment_ascii_with_time",
+};
+
+void tm1637_stats_record(tm1637_led_t * led, tm1637_api_t api, int64_t start)
+{
+	uint32_t us = esp_timer_get_time() - start;
+	int bucket = (us == 0) ? 0 : 32 - __builtin_clz(us);
+	if (bucket >= TM1637_STATS_BUCKETS) bucket = TM1637_STATS_BUCKETS - 1;
+
+	taskENTER_CRITICAL(&led->m_stats_mux);
+	tm1637_latency_t * latency = &led->m_stats.latency[api];
+	if (latency->calls == 0 || us < latency->min_us) latency->min_us = us;
+	if (us > latency->max_us) latency->max_us = us;
+	latency->total_us += us;
+	latency->calls++;
+	latency->histogram[bucket]++;
+	taskEXIT_CRITICAL(&led->m_stats_mux);
+}
+#endif
+
+#if CONFIG_TM1637_STATS && CONFIG_TM1637_STATS_DUMP_INTERVAL > 0
+static void tm1637_stats_dump_timer(void * arg)
+{
+	tm1637_dump_stats((tm1637_led_t *) arg);
+}
+#endif
+
+void tm1637_get_stats(tm1637_led_t * led, tm1637_stats_t * stats)
+{
+#if CONFIG_TM1637_STATS
+	taskENTER_CRITICAL(&led->m_stats_mux);
+	*stats = led->m_stats;
+	taskEXIT_CRITICAL(&led->m_stats_mux);
+	for (int api=0; api<TM1637_API_MAX; api++) {
+		tm1637_latency_t * latency = &stats->latency[api];
+		if (latency->calls == 0) continue;
+		latency->avg_us = latency->total_us / latency->calls;
+
+		// 99th percentile falls in the first bucket holding 99% of calls
+		uint32_t target = latency->calls - latency->calls / 100;
+		uint32_t count = 0;
+		for (int bucket=0; bucket<TM1637_STATS_BUCKETS; bucket++) {
+			count += latency->histogram[bucket];
+			if (count >= target) {
+				uint32_t upper = (1UL << bucket) - 1;
+				latency->p99_us = (upper < latency->max_us && bucket < TM1637_STATS_BUCKETS - 1) ? upper : latency->max_us;
+				break;
+			}
+		}
+	}
+#else
+	memset(stats, 0, sizeof(tm1637_stats_t));
+#endif
+}
+
+void tm1637_reset_stats(tm1637_led_t * led)
+{
+#if CONFIG_TM1637_STATS
+	taskENTER_CRITICAL(&led->m_stats_mux);
+	memset(&led->m_stats, 0, sizeof(tm1637_stats_t));
+	taskEXIT_CRITICAL(&led->m_stats_mux);
+#endif
+}
+
+void tm1637_dump_stats(tm1637_led_t * led)
+{
+#if CONFIG_TM1637_STATS
+	tm1637_stats_t stats;
+	tm1637_get_stats(led, &stats);
+	ESP_LOGI(__FUNCTION__, "transactions=%"PRIu32" bytes=%"PRIu32" elided=%"PRIu32" coalesced=%"PRIu32" nacks=%"PRIu32,
+		stats.transactions, stats.bytes, stats.elided, stats.coalesced, stats.nacks);
+	for (int api=0; api<TM1637_API_MAX; api++) {
+		tm1637_latency_t * latency = &stats.latency[api];
+		if (latency->calls == 0) continue;
+		ESP_LOGI(__FUNCTION__, "%s calls=%"PRIu32" min=%"PRIu32" avg=%"PRIu32" max=%"PRIu32" p99=%"PRIu32" us",
+			tm1637_api_name[api], latency->calls, latency->min_us, latency->avg_us, latency->max_us, latency->p99_us);
+	}
+#else
+	ESP_LOGW(__FUNCTION__, "CONFIG_TM1637_STATS is disabled");
+#endif
+}
@@ -16,6 +16,8 @@
 #include <inttypes.h>
 #include <stdbool.h>
 #include <driver/gpio.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,6 +25,39 @@ extern "C" {
 
 struct tm;
 
+typedef enum {
+	TM1637_API_SET_SEGMENT_FIXED,
+	TM1637_API_SET_SEGMENT_AUTO,
+	TM1637_API_SET_SEGMENT_FRAME,
+	TM1637_API_SET_SEGMENT_NUMBER,
+	TM1637_API_SET_NUMBER,
+	TM1637_API_SET_SEGMENT_ASCII,
+	TM1637_API_SET_SEGMENT_ASCII_WITH_TIME,
+	TM1637_API_MAX,
+} tm1637_api_t;
+
+// Bucket n counts latencies of 2^(n-1)..2^n-1 us, the last one everything above
+#define TM1637_STATS_BUCKETS 24
+
+typedef struct {
+	uint32_t calls;
+	uint32_t min_us;
+	uint32_t avg_us;
+	uint32_t max_us;
+	uint32_t p99_us;    // Upper bound of the histogram bucket
+	uint64_t total_us;
+	uint32_t histogram[TM1637_STATS_BUCKETS];
+} tm1637_latency_t;
+
+typedef struct {
+	uint32_t transactions; // Start/stop sequences on the bus
+	uint32_t bytes;
+	uint32_t elided;       // Updates not sent because the display already shows them
+	uint32_t coalesced;    // Updates replaced by a newer one before being sent
+	uint32_t nacks;
+	tm1637_latency_t latency[TM1637_API_MAX];
+} tm1637_stats_t;
+
 typedef struct {
 	int segment_idx[6];
 	int segment_start;
@@ -30,6 +65,13 @@ typedef struct {
 	gpio_num_t m_pin_clk;
 	gpio_num_t m_pin_dta;
 	uint8_t m_brightness;
+	uint8_t m_ram[6];         // Shadow of display RAM
+	uint8_t m_ram_valid;      // Bit per address of m_ram known to match the display
+	uint8_t m_ram_brightness; // Brightness last sent
+#if CONFIG_TM1637_STATS
+	tm1637_stats_t m_stats;
+	portMUX_TYPE m_stats_mux;
+#endif
 } tm1637_led_t;
 
 /**
@@ -41,6 +83,23 @@ typedef struct {
  */
 tm1637_led_t * tm1637_init(gpio_num_t pin_clk, gpio_num_t pin_data);
 
+/**
+ * @brief Constructs LED object after deep sleep from the state saved by tm1637_suspend, without touching the bus.
+ * Same as tm1637_init when no state was saved
+ *
+ * @param pin_clk GPIO pin for CLK input of LED module
+ * @param pin_data GPIO pin for DIO input of LED module
+ * @return
+ */
+tm1637_led_t * tm1637_resume(gpio_num_t pin_clk, gpio_num_t pin_data);
+
+/**
+ * @brief Save display state in RTC memory and hold pins. Call just before deep sleep
+ * @param led LED object
+ * @return false when no state was saved, pins are not held then
+ */
+bool tm1637_suspend(tm1637_led_t * led);
+
 /**
  * @brief Set brightness level. Note - will be set after next display render
  * @param led LED object
@@ -49,16 +108,16 @@ tm1637_led_t * tm1637_init(gpio_num_t pin_clk, gpio_num_t pin_data);
 void tm1637_set_brightness(tm1637_led_t * led, uint8_t level);
 
 /**
- * @brief Set ascii string
+ * @brief Set UTF-8 string, characters without a glyph show the fallback glyph
  * @param led LED object
- * @param text ascii string
+ * @param text UTF-8 string
  */
 void tm1637_set_segment_ascii(tm1637_led_t * led, char *text);
 
 /**
- * @brief Set ascii string
+ * @brief Set UTF-8 string, characters without a glyph show the fallback glyph
  * @param led LED object
- * @param text ascii string
+ * @param text UTF-8 string
  * @param dot_position dot position
  * @param time display time[ms]
  */
@@ -80,6 +139,13 @@ void tm1637_set_segment_fixed(tm1637_led_t * led, const int8_t segment_idx, cons
  */
 void tm1637_set_segment_auto(tm1637_led_t * led, const uint8_t *data, const int data_length);
 
+/**
+ * @brief Set all digits in one Automatic address adding burst
+ * @param led LED object
+ * @param frame Raw datas, one per digit from left to right (segment_max bytes)
+ */
+void tm1637_set_segment_frame(tm1637_led_t * led, const uint8_t *frame);
+
 /**
  * @brief Set one-segment number, also controls dot of this segment
  * @param led LED object
@@ -98,6 +164,25 @@ void tm1637_set_segment_number(tm1637_led_t * led, const int8_t segment_idx, con
  */
 void tm1637_set_number(tm1637_led_t * led, int32_t number, bool lead_zero, const uint16_t dot_position);
 
+/**
+ * @brief Get statistics. All zero unless CONFIG_TM1637_STATS is enabled.
+ * Safe to call from any task while the display is in use
+ * @param led LED object
+ * @param stats Output statistics
+ */
+void tm1637_get_stats(tm1637_led_t * led, tm1637_stats_t * stats);
+
+/**
+ * @brief Reset statistics
+ * @param led LED object
+ */
+void tm1637_reset_stats(tm1637_led_t * led);
+
+/**
+ * @brief Log statistics
+ * @param led LED object
+ */
+void tm1637_dump_stats(tm1637_led_t * led);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,191 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * C++17 header-only API. The module layout is a template parameter, so
+ * address mapping, dot capability and frame size are known at compile time
+ * and misuse, such as dots on a clock module, does not compile.
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_HPP
+#define TM1637_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "tm1637.h"
+#include "tm1637_font.h"
+
+namespace tm1637 {
+
+enum class Type {
+	Dot,   // 8 Segment with dot
+	Clock, // Clock Segment, colon instead of dots
+};
+
+// Display address of each digit, from left to right
+template <std::size_t Digits> struct Layout;
+
+template <> struct Layout<4> {
+	static constexpr std::array<uint8_t, 4> address{{0, 1, 2, 3}};
+};
+
+template <> struct Layout<6> {
+	static constexpr std::array<uint8_t, 6> address{{2, 1, 0, 5, 4, 3}};
+};
+
+namespace detail {
+
+// Same images as numerical_symbols, usable in constant expressions
+constexpr uint8_t digit_glyph[10] = {0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f};
+constexpr uint8_t minus_glyph = 0x40;
+constexpr uint8_t dot_flag = 0x80;
+
+template <std::size_t N>
+constexpr std::size_t max_address(const std::array<uint8_t, N> & address)
+{
+	std::size_t max = 0;
+	for (std::size_t i = 0; i < N; ++i) {
+		if (address[i] > max) max = address[i];
+	}
+	return max;
+}
+
+template <std::size_t N>
+constexpr bool unique_address(const std::array<uint8_t, N> & address)
+{
+	for (std::size_t i = 0; i < N; ++i) {
+		for (std::size_t j = i + 1; j < N; ++j) {
+			if (address[i] == address[j]) return false;
+		}
+	}
+	return true;
+}
+
+} // namespace detail
+
+template <std::size_t Digits, Type SegmentType, typename L = Layout<Digits>>
+class Display {
+public:
+	static constexpr std::size_t digits = Digits;
+	static constexpr bool has_dots = SegmentType == Type::Dot;
+	static constexpr bool has_colon = SegmentType == Type::Clock;
+	static constexpr std::array<uint8_t, Digits> address = L::address;
+	static constexpr std::size_t frame_size = detail::max_address(address) + 1;
+
+	static_assert(Digits == 4 || Digits == 6, "TM1637 modules have 4 or 6 digits");
+	static_assert(frame_size <= 6, "TM1637 has 6 display addresses");
+	static_assert(detail::unique_address(address), "layout maps two digits to one address");
+
+	// Raw datas, one per digit from left to right, bitmask is XGFEDCBA
+	using Frame = std::array<uint8_t, Digits>;
+
+	explicit Display(tm1637_led_t * led) : led_(led) {}
+	Display(gpio_num_t pin_clk, gpio_num_t pin_data) : led_(tm1637_init(pin_clk, pin_data)) {}
+
+	explicit operator bool() const { return led_ != nullptr; }
+	tm1637_led_t * get() const { return led_; }
+
+	void brightness(uint8_t level) { tm1637_set_brightness(led_, level); }
+
+	// Colon of a clock module, shown from the next write
+	void colon(bool on)
+	{
+		static_assert(has_colon, "this module has no colon, use dots");
+		static_assert(Digits == 4, "colon is only known on 4 digit clock modules");
+		colon_ = on;
+	}
+
+	// Write all digits in one burst
+	void write(const Frame & frame) const { write(frame, std::make_index_sequence<Digits>{}); }
+
+	// Format number, nullopt when it does not fit
+	template <uint16_t DotPosition = 0>
+	static constexpr std::optional<Frame> format_number(int32_t number, bool lead_zero)
+	{
+		static_assert(DotPosition == 0 || has_dots, "this module has no dots");
+		static_assert(DotPosition < (1u << Digits), "dot position is outside the display");
+
+		Frame frame{};
+		const bool negative = number < 0;
+		uint32_t value = negative ? 0u - static_cast<uint32_t>(number) : static_cast<uint32_t>(number);
+		std::size_t used = 0;
+		for (std::size_t k = 0; k < Digits; ++k) {
+			if (k == 0 || value != 0) {
+				frame[Digits - 1 - k] = detail::digit_glyph[value % 10];
+				value /= 10;
+				used = k + 1;
+			}
+		}
+		if (value != 0 || (negative && used == Digits)) return std::nullopt;
+
+		// Digits left of the number, first one is the sign
+		const std::size_t free = Digits - used;
+		for (std::size_t i = 0; i < free; ++i) {
+			if (lead_zero) {
+				frame[i] = (negative && i == 0) ? detail::minus_glyph : detail::digit_glyph[0];
+			} else if (negative && i == free - 1) {
+				frame[i] = detail::minus_glyph;
+			}
+		}
+
+		for (std::size_t k = 0; k < Digits; ++k) {
+			if (DotPosition & (1u << k)) frame[Digits - 1 - k] |= detail::dot_flag;
+		}
+		return frame;
+	}
+
+	/**
+	 * @brief Set full display number, in decimal encoding
+	 * @tparam DotPosition dot position, rejected at compile time on clock modules
+	 * @return false when the number does not fit, display is left unchanged
+	 */
+	template <uint16_t DotPosition = 0>
+	bool number(int32_t number, bool lead_zero = false) const
+	{
+		auto frame = format_number<DotPosition>(number, lead_zero);
+		if (!frame) return false;
+		write(*frame);
+		return true;
+	}
+
+	// Set UTF-8 string, right aligned, extra characters are cut
+	void text(const char * text) const
+	{
+		Frame frame{};
+		std::size_t length = tm1637_utf8_length(text);
+		if (length > Digits) length = Digits;
+		for (std::size_t i = Digits - length; i < Digits; ++i) {
+			frame[i] = tm1637_font_glyph(tm1637_utf8_next(&text));
+		}
+		write(frame);
+	}
+
+private:
+	template <std::size_t... I>
+	void write(const Frame & frame, std::index_sequence<I...>) const
+	{
+		uint8_t data[frame_size] = {};
+		((data[address[I]] = frame[I]), ...);
+		if constexpr (has_colon && Digits == 4) {
+			if (colon_) data[address[1]] |= detail::dot_flag;
+		}
+		tm1637_set_segment_auto(led_, data, frame_size);
+	}
+
+	tm1637_led_t * led_;
+	bool colon_ = false;
+};
+
+using Display4 = Display<4, Type::Dot>;
+using Display6 = Display<6, Type::Dot>;
+using Clock4 = Display<4, Type::Clock>;
+
+} // namespace tm1637
+
+#endif // TM1637_HPP
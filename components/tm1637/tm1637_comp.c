@@ -0,0 +1,134 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Layered compositor for overlays and notifications
+ *
+ * Each digit shows the highest layer that covers it. Layers are merged in
+ * one pass and the result goes through tm1637_set_segment_frame, which
+ * sends the address span from the first to the last changed digit in one
+ * burst, or nothing when no digit changed. When a layer expires, a one-shot
+ * timer wakes a small task that clears it and redraws, so the layers
+ * below come back without help from the app. The bus is never driven
+ * from the esp_timer task.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "tm1637_comp.h"
+
+// Called with lock held
+static void tm1637_comp_render(tm1637_comp_t * comp)
+{
+	int64_t now = esp_timer_get_time();
+	int64_t next = 0;
+	for (int l=0; l<TM1637_LAYER_MAX; l++) {
+		tm1637_layer_t * layer = &comp->layer[l];
+		if (layer->expire_us == 0) continue;
+		if (layer->expire_us <= now) {
+			layer->mask = 0;
+			layer->expire_us = 0;
+		} else if (next == 0 || layer->expire_us < next) {
+			next = layer->expire_us;
+		}
+	}
+
+	uint8_t frame[6] = {0,0,0,0,0,0};
+	int last = comp->led->segment_max - 1;
+	for (int i=0; i<=last; i++) {
+		for (int l=TM1637_LAYER_MAX-1; l>=0; l--) {
+			if (comp->layer[l].mask & (1 << (last - i))) {
+				frame[i] = comp->layer[l].frame[i];
+				break;
+			}
+		}
+	}
+	tm1637_set_segment_frame(comp->led, frame);
+
+	esp_timer_stop(comp->timer);
+	if (next) esp_timer_start_once(comp->timer, next - now);
+}
+
+// esp_timer callback, only wakes the task
+static void tm1637_comp_expire(void * arg)
+{
+	tm1637_comp_t * comp = (tm1637_comp_t *) arg;
+	xTaskNotifyGive(comp->task);
+}
+
+static void tm1637_comp_task(void * arg)
+{
+	tm1637_comp_t * comp = (tm1637_comp_t *) arg;
+	while (true) {
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		xSemaphoreTake(comp->lock, portMAX_DELAY);
+		tm1637_comp_render(comp);
+		xSemaphoreGive(comp->lock);
+	}
+}
+
+tm1637_comp_t * tm1637_comp_init(tm1637_led_t * led)
+{
+	tm1637_comp_t * comp = (tm1637_comp_t *) calloc(1, sizeof(tm1637_comp_t));
+	if (comp == NULL) {
+		ESP_LOGE(__FUNCTION__,"calloc fail");
+		return NULL;
+	}
+
+	comp->led = led;
+	comp->lock = xSemaphoreCreateMutex();
+	if (comp->lock == NULL) {
+		ESP_LOGE(__FUNCTION__,"xSemaphoreCreateMutex fail");
+		free(comp);
+		return NULL;
+	}
+	const esp_timer_create_args_t timer_args = {
+		.callback = tm1637_comp_expire,
+		.arg = comp,
+		.name = "tm1637_comp",
+	};
+	if (xTaskCreate(tm1637_comp_task, "tm1637_comp", 1024*2, comp, uxTaskPriorityGet(NULL), &comp->task) != pdPASS) {
+		ESP_LOGE(__FUNCTION__,"xTaskCreate fail");
+		vSemaphoreDelete(comp->lock);
+		free(comp);
+		return NULL;
+	}
+	if (esp_timer_create(&timer_args, &comp->timer) != ESP_OK) {
+		ESP_LOGE(__FUNCTION__,"esp_timer_create fail");
+		vTaskDelete(comp->task);
+		vSemaphoreDelete(comp->lock);
+		free(comp);
+		return NULL;
+	}
+	return comp;
+}
+
+void tm1637_comp_set(tm1637_comp_t * comp, tm1637_layer_id_t layer, const uint8_t *frame, uint8_t mask, uint32_t timeout_ms)
+{
+	if (layer >= TM1637_LAYER_MAX) return;
+	xSemaphoreTake(comp->lock, portMAX_DELAY);
+	memcpy(comp->layer[layer].frame, frame, comp->led->segment_max);
+	comp->layer[layer].mask = mask;
+	comp->layer[layer].expire_us = timeout_ms ? esp_timer_get_time() + (int64_t)timeout_ms * 1000 : 0;
+	tm1637_comp_render(comp);
+	xSemaphoreGive(comp->lock);
+}
+
+void tm1637_comp_clear(tm1637_comp_t * comp, tm1637_layer_id_t layer)
+{
+	if (layer >= TM1637_LAYER_MAX) return;
+	xSemaphoreTake(comp->lock, portMAX_DELAY);
+	comp->layer[layer].mask = 0;
+	comp->layer[layer].expire_us = 0;
+	tm1637_comp_render(comp);
+	xSemaphoreGive(comp->lock);
+}
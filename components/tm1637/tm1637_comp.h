@@ -0,0 +1,79 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Layered compositor for overlays and notifications
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_COMP_H
+#define TM1637_COMP_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#include "tm1637.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Digit mask, bit 0 is the right digit like dot_position
+#define TM1637_COMP_ALL 0x3F
+
+typedef enum {
+	TM1637_LAYER_BASE,   // Lowest priority
+	TM1637_LAYER_STATUS,
+	TM1637_LAYER_ALERT,  // Highest priority
+	TM1637_LAYER_MAX,
+} tm1637_layer_id_t;
+
+typedef struct {
+	uint8_t frame[6];    // Raw datas, one per digit from left to right
+	uint8_t mask;        // Digits this layer covers
+	int64_t expire_us;   // esp_timer time the layer is cleared, 0 for never
+} tm1637_layer_t;
+
+typedef struct {
+	tm1637_led_t * led;
+	tm1637_layer_t layer[TM1637_LAYER_MAX];
+	SemaphoreHandle_t lock;
+	esp_timer_handle_t timer;
+	TaskHandle_t task;   // Redraws when a layer expires
+} tm1637_comp_t;
+
+/**
+ * @brief Constructs new compositor object. Write the display only through it afterwards.
+ * Starts a task with the priority of the caller that redraws when a layer expires
+ * @param led LED object
+ * @return
+ */
+tm1637_comp_t * tm1637_comp_init(tm1637_led_t * led);
+
+/**
+ * @brief Set layer content and show the composited display
+ * @param comp Compositor object
+ * @param layer Layer
+ * @param frame Raw datas, one per digit from left to right (segment_max bytes)
+ * @param mask Digits the layer covers, bit 0 is the right digit
+ * @param timeout_ms Time until the layer is cleared (0 for never)
+ */
+void tm1637_comp_set(tm1637_comp_t * comp, tm1637_layer_id_t layer, const uint8_t *frame, uint8_t mask, uint32_t timeout_ms);
+
+/**
+ * @brief Clear layer and show the composited display
+ * @param comp Compositor object
+ * @param layer Layer
+ */
+void tm1637_comp_clear(tm1637_comp_t * comp, tm1637_layer_id_t layer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TM1637_COMP_H
@@ -0,0 +1,131 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Glyph lookup by Unicode code point and UTF-8 decoding
+ *
+ * ASCII is a direct table lookup. Other code points are kept in an array
+ * sorted by code point, so lookup is a short binary search.
+ *
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "tm1637_font.h"
+#include "symbols.h"
+
+typedef struct {
+	uint32_t code_point;
+	uint8_t glyph;
+} tm1637_glyph_t;
+
+static tm1637_glyph_t font_ext[CONFIG_TM1637_FONT_EXT_MAX] = {
+	// XGFEDCBA
+	{0x00B0, 0x63}, // degree sign
+	{0x00B5, 0x1C}, // micro sign
+	{0x2212, 0x40}, // minus sign
+};
+static int font_ext_num = 3;
+static uint8_t font_fallback = CONFIG_TM1637_FONT_FALLBACK;
+
+// Index of code_point, or of the entry it has to be inserted before
+static int tm1637_font_find(uint32_t code_point)
+{
+	int low = 0;
+	int high = font_ext_num;
+	while (low < high) {
+		int mid = (low + high) / 2;
+		if (font_ext[mid].code_point < code_point) {
+			low = mid + 1;
+		} else {
+			high = mid;
+		}
+	}
+	return low;
+}
+
+uint8_t tm1637_font_glyph(uint32_t code_point)
+{
+	if (code_point < sizeof(ascii_symbols)) return ascii_symbols[code_point];
+
+	int idx = tm1637_font_find(code_point);
+	if (idx < font_ext_num && font_ext[idx].code_point == code_point) {
+		return font_ext[idx].glyph;
+	}
+	return font_fallback;
+}
+
+bool tm1637_font_register(uint32_t code_point, uint8_t glyph)
+{
+	if (code_point < sizeof(ascii_symbols)) {
+		ESP_LOGE(__FUNCTION__,"0x%"PRIx32" is ASCII", code_point);
+		return false;
+	}
+
+	int idx = tm1637_font_find(code_point);
+	if (idx < font_ext_num && font_ext[idx].code_point == code_point) {
+		font_ext[idx].glyph = glyph;
+		return true;
+	}
+	if (font_ext_num >= CONFIG_TM1637_FONT_EXT_MAX) {
+		ESP_LOGE(__FUNCTION__,"font table full");
+		return false;
+	}
+	memmove(&font_ext[idx+1], &font_ext[idx], (font_ext_num - idx) * sizeof(tm1637_glyph_t));
+	font_ext[idx].code_point = code_point;
+	font_ext[idx].glyph = glyph;
+	font_ext_num++;
+	return true;
+}
+
+void tm1637_font_set_fallback(uint8_t glyph)
+{
+	font_fallback = glyph;
+}
+
+uint32_t tm1637_utf8_next(const char ** text)
+{
+	const uint8_t * p = (const uint8_t *) *text;
+	uint32_t code_point;
+	int length;
+
+	if (p[0] == 0) return 0;
+	if (p[0] < 0x80) {
+		*text += 1;
+		return p[0];
+	} else if ((p[0] & 0xE0) == 0xC0) {
+		code_point = p[0] & 0x1F;
+		length = 2;
+	} else if ((p[0] & 0xF0) == 0xE0) {
+		code_point = p[0] & 0x0F;
+		length = 3;
+	} else if ((p[0] & 0xF8) == 0xF0) {
+		code_point = p[0] & 0x07;
+		length = 4;
+	} else {
+		// Stray continuation byte
+		*text += 1;
+		return TM1637_UTF8_INVALID;
+	}
+
+	for (int i=1;i<length;i++) {
+		if ((p[i] & 0xC0) != 0x80) {
+			// Truncated sequence, resume at the byte that broke it
+			*text += i;
+			return TM1637_UTF8_INVALID;
+		}
+		code_point = (code_point << 6) | (p[i] & 0x3F);
+	}
+	*text += length;
+	return code_point;
+}
+
+int tm1637_utf8_length(const char * text)
+{
+	int length = 0;
+	while (tm1637_utf8_next(&text) != 0) length++;
+	return length;
+}
@@ -0,0 +1,63 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Glyph lookup by Unicode code point and UTF-8 decoding
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_FONT_H
+#define TM1637_FONT_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Code point returned for broken UTF-8
+#define TM1637_UTF8_INVALID 0xFFFD
+
+/**
+ * @brief Get segment image of a code point
+ * @param code_point Unicode code point
+ * @return Raw data, bitmask is XGFEDCBA. Fallback glyph when unknown
+ */
+uint8_t tm1637_font_glyph(uint32_t code_point);
+
+/**
+ * @brief Add or replace a glyph above ASCII. Call before rendering starts
+ * @param code_point Unicode code point (0x80 or above)
+ * @param glyph Raw data, bitmask is XGFEDCBA
+ * @return false when the table is full
+ */
+bool tm1637_font_register(uint32_t code_point, uint8_t glyph);
+
+/**
+ * @brief Set glyph shown for unknown code points and broken UTF-8
+ * @param glyph Raw data, bitmask is XGFEDCBA
+ */
+void tm1637_font_set_fallback(uint8_t glyph);
+
+/**
+ * @brief Decode next UTF-8 character
+ * @param text Position in string, advanced past the character
+ * @return Code point, 0 at end of string
+ */
+uint32_t tm1637_utf8_next(const char ** text);
+
+/**
+ * @brief Count UTF-8 characters
+ * @param text UTF-8 string
+ * @return Number of characters
+ */
+int tm1637_utf8_length(const char * text);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TM1637_FONT_H
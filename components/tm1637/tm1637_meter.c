@@ -0,0 +1,122 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Bar-graph / level-meter rendering
+ *
+ * The frame of every level and every peak marker is built once at init,
+ * so an update is a table lookup and one burst, and nothing is sent while
+ * the quantised level and peak stay the same.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "tm1637_meter.h"
+#include "tm1637_priv.h"
+
+/*
+Segment position
+    a
+   ---
+ f| g |b
+   ---
+ e|   |c
+   ---
+    d
+*/
+
+// Half digits from left to right
+static const uint8_t horizontal_steps[] = {
+	0x30, // 0b00110000, e/f
+	0x06, // 0b00000110, b/c
+};
+
+// Bars from bottom to top
+static const uint8_t vertical_steps[] = {
+	0x08, // 0b00001000, d
+	0x14, // 0b00010100, c/e
+	0x40, // 0b01000000, g
+	0x22, // 0b00100010, b/f
+	0x01, // 0b00000001, a
+};
+
+tm1637_meter_t * tm1637_meter_init(tm1637_led_t * led, tm1637_meter_dir_t dir, uint32_t range, uint32_t hold_ms, uint32_t decay_ms)
+{
+	tm1637_meter_t * meter = (tm1637_meter_t *) calloc(1, sizeof(tm1637_meter_t));
+	if (meter == NULL) {
+		ESP_LOGE(__FUNCTION__,"calloc fail");
+		return NULL;
+	}
+
+	meter->led = led;
+	meter->range = range ? range : 1;
+	meter->hold_us = (int64_t)hold_ms * 1000;
+	meter->decay_us = (int64_t)decay_ms * 1000;
+	meter->shown_level = -1;
+	meter->shown_peak = -1;
+
+	if (dir == TM1637_METER_HORIZONTAL) {
+		meter->levels = led->segment_max * 2;
+		for (int level=1; level<=meter->levels; level++) {
+			int digit = (level - 1) / 2;
+			uint8_t step = horizontal_steps[(level - 1) % 2];
+			memcpy(meter->bar[level], meter->bar[level-1], 6);
+			meter->bar[level][digit] |= step;
+			meter->mark[level][digit] = step;
+		}
+	} else {
+		meter->levels = sizeof(vertical_steps);
+		for (int level=1; level<=meter->levels; level++) {
+			uint8_t step = vertical_steps[level - 1];
+			for (int digit=0; digit<led->segment_max; digit++) {
+				meter->bar[level][digit] = meter->bar[level-1][digit] | step;
+				meter->mark[level][digit] = step;
+			}
+		}
+	}
+	return meter;
+}
+
+bool tm1637_meter_update(tm1637_meter_t * meter, uint32_t value)
+{
+	int64_t now = esp_timer_get_time();
+	int level = meter->levels;
+	if (value < meter->range) {
+		level = (uint64_t)value * meter->levels / meter->range;
+	}
+
+	// Peak is held, then falls one level every decay_us
+	int peak = level;
+	int64_t elapsed = now - meter->peak_time - meter->hold_us;
+	if (elapsed < 0) {
+		peak = meter->peak;
+	} else if (meter->decay_us) {
+		int64_t fall = elapsed / meter->decay_us;
+		if (fall < meter->peak) peak = meter->peak - fall;
+	}
+	if (level >= peak) {
+		peak = level;
+		meter->peak = level;
+		meter->peak_time = now;
+	}
+
+	if (level == meter->shown_level && peak == meter->shown_peak) {
+		TM1637_STATS_ADD(meter->led, elided, 1);
+		return false;
+	}
+
+	uint8_t frame[6];
+	for (int i=0; i<6; i++) {
+		frame[i] = meter->bar[level][i] | meter->mark[peak][i];
+	}
+	tm1637_set_segment_frame(meter->led, frame);
+	meter->shown_level = level;
+	meter->shown_peak = peak;
+	return true;
+}
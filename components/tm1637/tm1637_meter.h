@@ -0,0 +1,66 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Bar-graph / level-meter rendering
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_METER_H
+#define TM1637_METER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+
+#include "tm1637.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TM1637_METER_LEVEL_MAX 12
+
+typedef enum {
+	TM1637_METER_HORIZONTAL, // Two vertical bars per digit, left to right
+	TM1637_METER_VERTICAL,   // Five horizontal steps on every digit, bottom to top
+} tm1637_meter_dir_t;
+
+typedef struct {
+	tm1637_led_t * led;
+	int levels;
+	uint32_t range;
+	int64_t hold_us;
+	int64_t decay_us;
+	uint8_t bar[TM1637_METER_LEVEL_MAX+1][6];  // Frame of each level
+	uint8_t mark[TM1637_METER_LEVEL_MAX+1][6]; // Frame of each peak marker
+	int peak;                                  // Held peak level
+	int64_t peak_time;
+	int shown_level;                           // -1 before first render
+	int shown_peak;
+} tm1637_meter_t;
+
+/**
+ * @brief Constructs new level meter object
+ * @param led LED object
+ * @param dir Bar direction
+ * @param range Input value of full scale
+ * @param hold_ms Time the peak marker is held
+ * @param decay_ms Time the peak marker falls by one level after hold (0 to drop at once)
+ * @return
+ */
+tm1637_meter_t * tm1637_meter_init(tm1637_led_t * led, tm1637_meter_dir_t dir, uint32_t range, uint32_t hold_ms, uint32_t decay_ms);
+
+/**
+ * @brief Set input value. Display is written only when the level or peak changes
+ * @param meter Level meter object
+ * @param value Input value (0..range)
+ * @return true when the display was written
+ */
+bool tm1637_meter_update(tm1637_meter_t * meter, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TM1637_METER_H
@@ -0,0 +1,35 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Internal helpers shared by the library sources
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_PRIV_H
+#define TM1637_PRIV_H
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+#include "tm1637.h"
+
+#if CONFIG_TM1637_STATS
+void tm1637_stats_record(tm1637_led_t * led, tm1637_api_t api, int64_t start);
+
+#define TM1637_STATS_BEGIN() int64_t _stats_start = esp_timer_get_time()
+#define TM1637_STATS_END(led, api) tm1637_stats_record(led, api, _stats_start)
+#define TM1637_STATS_ADD(led, counter, n) do { \
+		uint32_t _stats_n = (n); \
+		taskENTER_CRITICAL(&(led)->m_stats_mux); \
+		(led)->m_stats.counter += _stats_n; \
+		taskEXIT_CRITICAL(&(led)->m_stats_mux); \
+	} while (0)
+#else
+#define TM1637_STATS_BEGIN() do {} while (0)
+#define TM1637_STATS_END(led, api) do {} while (0)
+#define TM1637_STATS_ADD(led, counter, n) do {} while (0)
+#endif
+
+#endif // TM1637_PRIV_H
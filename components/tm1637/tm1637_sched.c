@@ -0,0 +1,218 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Refresh scheduler for many TM1637 modules
+ *
+ * Every call to tm1637_sched_service() is one period. Dirty displays are
+ * served by priority until the period budget is used up. Waiting raises
+ * the priority of a display by one level every aging_us, and a display
+ * past its max staleness goes before all others, so none starve.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "tm1637_sched.h"
+#include "tm1637_priv.h"
+
+// Bus time of one byte (9 clocks) until the first frame is measured
+#define TM1637_SCHED_BYTE_US 40
+
+static void tm1637_sched_clear_stats(tm1637_sched_entry_t * entry)
+{
+	uint32_t cost_us = entry->stats.cost_us;
+	memset(&entry->stats, 0, sizeof(entry->stats));
+	entry->stats.latency_min_us = UINT32_MAX;
+	entry->stats.cost_us = cost_us;
+	entry->latency_sum_us = 0;
+}
+
+static int64_t tm1637_sched_score(tm1637_sched_t * sched, tm1637_sched_entry_t * entry, int64_t now)
+{
+	int64_t age = now - entry->pending_since;
+	if (entry->max_stale_us && age > entry->max_stale_us) {
+		// Overdue displays go first, the most overdue ahead
+		return INT64_MAX / 2 + (age - entry->max_stale_us);
+	}
+	return (int64_t)entry->priority * sched->aging_us + age;
+}
+
+// PUBLIC PART:
+
+tm1637_sched_t * tm1637_sched_init(int entry_max, uint32_t budget_us, uint32_t aging_us)
+{
+	if (aging_us == 0) {
+		// Score would be pure age and priority would be ignored
+		ESP_LOGE(__FUNCTION__,"aging_us must not be 0");
+		return NULL;
+	}
+
+	tm1637_sched_t * sched = (tm1637_sched_t *) malloc(sizeof(tm1637_sched_t));
+	if (sched == NULL) {
+		ESP_LOGE(__FUNCTION__,"malloc fail");
+		return NULL;
+	}
+	sched->entry = (tm1637_sched_entry_t *) calloc(entry_max, sizeof(tm1637_sched_entry_t));
+	if (sched->entry == NULL) {
+		ESP_LOGE(__FUNCTION__,"calloc fail");
+		free(sched);
+		return NULL;
+	}
+	sched->entry_num = 0;
+	sched->entry_max = entry_max;
+	sched->budget_us = budget_us;
+	sched->aging_us = aging_us;
+	sched->period = 0;
+	sched->deferred = 0;
+	portMUX_INITIALIZE(&sched->mux);
+	return sched;
+}
+
+int tm1637_sched_add(tm1637_sched_t * sched, tm1637_led_t * led, uint8_t priority, uint32_t max_stale_ms)
+{
+	taskENTER_CRITICAL(&sched->mux);
+	if (sched->entry_num >= sched->entry_max) {
+		taskEXIT_CRITICAL(&sched->mux);
+		ESP_LOGE(__FUNCTION__,"too many displays");
+		return -1;
+	}
+	int id = sched->entry_num;
+	tm1637_sched_entry_t * entry = &sched->entry[id];
+	memset(entry, 0, sizeof(tm1637_sched_entry_t));
+	entry->led = led;
+	entry->priority = priority;
+	entry->max_stale_us = (int64_t)max_stale_ms * 1000;
+	entry->stats.cost_us = (led->segment_max + 3) * TM1637_SCHED_BYTE_US;
+	tm1637_sched_clear_stats(entry);
+	sched->entry_num++;
+	taskEXIT_CRITICAL(&sched->mux);
+	return id;
+}
+
+void tm1637_sched_submit(tm1637_sched_t * sched, int id, const uint8_t *frame)
+{
+	int64_t now = esp_timer_get_time();
+
+	taskENTER_CRITICAL(&sched->mux);
+	if (id < 0 || id >= sched->entry_num) {
+		taskEXIT_CRITICAL(&sched->mux);
+		return;
+	}
+	tm1637_sched_entry_t * entry = &sched->entry[id];
+	int length = entry->led->segment_max;
+	entry->stats.submitted++;
+	if (entry->dirty) {
+		entry->stats.superseded++;
+		TM1637_STATS_ADD(entry->led, coalesced, 1);
+	} else if (entry->shown_valid && memcmp(entry->shown, frame, length) == 0) {
+		entry->stats.unchanged++;
+		TM1637_STATS_ADD(entry->led, elided, 1);
+		taskEXIT_CRITICAL(&sched->mux);
+		return;
+	} else {
+		entry->pending_since = now;
+	}
+	memcpy(entry->frame, frame, length);
+	entry->submitted_at = now;
+	entry->dirty = true;
+	taskEXIT_CRITICAL(&sched->mux);
+}
+
+int tm1637_sched_service(tm1637_sched_t * sched)
+{
+	int sent = 0;
+	int64_t spent = 0;
+	uint8_t frame[6];
+
+	sched->period++;
+	while (true) {
+		int64_t now = esp_timer_get_time();
+		tm1637_sched_entry_t * best = NULL;
+		int64_t best_score = INT64_MIN;
+		taskENTER_CRITICAL(&sched->mux);
+		for (int i=0;i<sched->entry_num;i++) {
+			tm1637_sched_entry_t * entry = &sched->entry[i];
+			if (!entry->dirty || entry->served == sched->period) continue;
+			int64_t score = tm1637_sched_score(sched, entry, now);
+			if (score > best_score) {
+				best = entry;
+				best_score = score;
+			}
+		}
+		// The first frame of a period is always sent, so a small budget still makes progress
+		if (best == NULL || (sent > 0 && spent + best->stats.cost_us > sched->budget_us)) {
+			taskEXIT_CRITICAL(&sched->mux);
+			break;
+		}
+		memcpy(frame, best->frame, best->led->segment_max);
+		int64_t submitted_at = best->submitted_at;
+		int64_t pending_since = best->pending_since;
+		best->dirty = false;
+		best->served = sched->period;
+		taskEXIT_CRITICAL(&sched->mux);
+
+		int64_t start = esp_timer_get_time();
+		tm1637_set_segment_frame(best->led, frame);
+		int64_t end = esp_timer_get_time();
+
+		taskENTER_CRITICAL(&sched->mux);
+		memcpy(best->shown, frame, best->led->segment_max);
+		best->shown_valid = true;
+		tm1637_sched_stats_t * stats = &best->stats;
+		stats->cost_us = (stats->cost_us * 3 + (uint32_t)(end - start)) / 4;
+		uint32_t latency = end - submitted_at;
+		if (latency < stats->latency_min_us) stats->latency_min_us = latency;
+		if (latency > stats->latency_max_us) stats->latency_max_us = latency;
+		best->latency_sum_us += latency;
+		stats->sent++;
+		if (best->max_stale_us && end - pending_since > best->max_stale_us) stats->late++;
+		taskEXIT_CRITICAL(&sched->mux);
+
+		spent += end - start;
+		sent++;
+	}
+
+	for (int i=0;i<sched->entry_num;i++) {
+		if (sched->entry[i].dirty) {
+			sched->deferred++;
+			break;
+		}
+	}
+	return sent;
+}
+
+void tm1637_sched_get_stats(tm1637_sched_t * sched, int id, tm1637_sched_stats_t * stats)
+{
+	int64_t now = esp_timer_get_time();
+
+	taskENTER_CRITICAL(&sched->mux);
+	if (id < 0 || id >= sched->entry_num) {
+		taskEXIT_CRITICAL(&sched->mux);
+		return;
+	}
+	tm1637_sched_entry_t * entry = &sched->entry[id];
+	*stats = entry->stats;
+	if (stats->sent) {
+		stats->latency_avg_us = entry->latency_sum_us / stats->sent;
+	} else {
+		stats->latency_min_us = 0;
+	}
+	stats->backlog_us = entry->dirty ? (uint32_t)(now - entry->pending_since) : 0;
+	taskEXIT_CRITICAL(&sched->mux);
+}
+
+void tm1637_sched_reset_stats(tm1637_sched_t * sched, int id)
+{
+	taskENTER_CRITICAL(&sched->mux);
+	if (id >= 0 && id < sched->entry_num) {
+		tm1637_sched_clear_stats(&sched->entry[id]);
+	}
+	taskEXIT_CRITICAL(&sched->mux);
+}
@@ -0,0 +1,115 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Refresh scheduler for many TM1637 modules
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_SCHED_H
+#define TM1637_SCHED_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+
+#include "tm1637.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	uint32_t submitted;      // Frames handed to the scheduler
+	uint32_t sent;           // Frames written to the module
+	uint32_t superseded;     // Frames replaced before they were sent
+	uint32_t unchanged;      // Frames dropped because the module already shows them
+	uint32_t late;           // Frames sent after max staleness
+	uint32_t latency_min_us; // Submit to sent
+	uint32_t latency_avg_us;
+	uint32_t latency_max_us;
+	uint32_t backlog_us;     // Age of the pending frame, 0 when nothing is pending
+	uint32_t cost_us;        // Measured bus time of one frame
+} tm1637_sched_stats_t;
+
+typedef struct {
+	tm1637_led_t * led;
+	uint8_t priority;
+	int64_t max_stale_us;
+	uint8_t frame[6];
+	uint8_t shown[6];
+	bool shown_valid;
+	bool dirty;
+	uint32_t served;         // Period in which this display was last served
+	int64_t pending_since;   // Submit time of the oldest unsent frame
+	int64_t submitted_at;    // Submit time of the pending frame
+	uint64_t latency_sum_us;
+	tm1637_sched_stats_t stats;
+} tm1637_sched_entry_t;
+
+typedef struct {
+	tm1637_sched_entry_t * entry;
+	int entry_num;
+	int entry_max;
+	uint32_t budget_us;
+	uint32_t aging_us;
+	uint32_t period;
+	uint32_t deferred;       // Periods that ended with frames still pending
+	portMUX_TYPE mux;
+} tm1637_sched_t;
+
+/**
+ * @brief Constructs new scheduler object
+ * @param entry_max Maximum number of displays
+ * @param budget_us Bus time allowed per tm1637_sched_service() call
+ * @param aging_us Waiting time worth one priority level (must not be 0)
+ * @return
+ */
+tm1637_sched_t * tm1637_sched_init(int entry_max, uint32_t budget_us, uint32_t aging_us);
+
+/**
+ * @brief Add display to scheduler
+ * @param sched Scheduler object
+ * @param led LED object
+ * @param priority Priority, higher is served first
+ * @param max_stale_ms Maximum time a frame may wait (0 for no limit)
+ * @return Display id, -1 when full
+ */
+int tm1637_sched_add(tm1637_sched_t * sched, tm1637_led_t * led, uint8_t priority, uint32_t max_stale_ms);
+
+/**
+ * @brief Queue frame for display. Replaces a frame not yet sent
+ * @param sched Scheduler object
+ * @param id Display id
+ * @param frame Raw datas, one per digit from left to right (segment_max bytes)
+ */
+void tm1637_sched_submit(tm1637_sched_t * sched, int id, const uint8_t *frame);
+
+/**
+ * @brief Send pending frames within one period budget. Call once per period
+ * @param sched Scheduler object
+ * @return Number of frames sent
+ */
+int tm1637_sched_service(tm1637_sched_t * sched);
+
+/**
+ * @brief Get display statistics
+ * @param sched Scheduler object
+ * @param id Display id
+ * @param stats Output statistics
+ */
+void tm1637_sched_get_stats(tm1637_sched_t * sched, int id, tm1637_sched_stats_t * stats);
+
+/**
+ * @brief Reset display statistics
+ * @param sched Scheduler object
+ * @param id Display id
+ */
+void tm1637_sched_reset_stats(tm1637_sched_t * sched, int id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TM1637_SCHED_H
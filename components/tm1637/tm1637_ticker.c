@@ -0,0 +1,155 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Streaming ticker fed from a FreeRTOS StreamBuffer
+ *
+ * Bytes are taken from the stream one character at a time and turned into
+ * a glyph in the window ring, so memory use does not depend on how long
+ * the stream runs.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "tm1637_ticker.h"
+#include "tm1637_font.h"
+
+// Length of UTF-8 character from its first byte, 1 for broken bytes
+static int tm1637_ticker_utf8_need(uint8_t c)
+{
+	if ((c & 0xE0) == 0xC0) return 2;
+	if ((c & 0xF0) == 0xE0) return 3;
+	if ((c & 0xF8) == 0xF0) return 4;
+	return 1;
+}
+
+// Next complete character from the stream, 0 when none is available
+static uint32_t tm1637_ticker_next(tm1637_ticker_t * ticker)
+{
+	char c;
+	while (true) {
+		if (ticker->utf8_len > 0 && ticker->utf8_len >= ticker->utf8_need) {
+			ticker->utf8[ticker->utf8_len] = 0;
+			ticker->utf8_len = 0;
+			const char * p = ticker->utf8;
+			return tm1637_utf8_next(&p);
+		}
+		if (xStreamBufferReceive(ticker->stream, &c, 1, 0) != 1) return 0;
+		if (c == 0) continue;
+		if (ticker->utf8_len > 0 && ((uint8_t)c & 0xC0) != 0x80) {
+			// Broken character, start over from this byte
+			ticker->utf8[0] = c;
+			ticker->utf8_len = 1;
+			ticker->utf8_need = tm1637_ticker_utf8_need(c);
+			return TM1637_UTF8_INVALID;
+		}
+		if (ticker->utf8_len == 0) ticker->utf8_need = tm1637_ticker_utf8_need(c);
+		ticker->utf8[ticker->utf8_len++] = c;
+	}
+}
+
+tm1637_ticker_t * tm1637_ticker_init(tm1637_led_t * led, StreamBufferHandle_t stream, size_t buffer_size, uint32_t step_ms, tm1637_ticker_policy_t policy)
+{
+	tm1637_ticker_t * ticker = (tm1637_ticker_t *) calloc(1, sizeof(tm1637_ticker_t));
+	if (ticker == NULL) {
+		ESP_LOGE(__FUNCTION__,"calloc fail");
+		return NULL;
+	}
+
+	portMUX_INITIALIZE(&ticker->mux);
+	ticker->lock = xSemaphoreCreateMutex();
+	if (ticker->lock == NULL) {
+		ESP_LOGE(__FUNCTION__,"xSemaphoreCreateMutex fail");
+		free(ticker);
+		return NULL;
+	}
+	if (stream == NULL) {
+		stream = xStreamBufferCreate(buffer_size, 1);
+		if (stream == NULL) {
+			ESP_LOGE(__FUNCTION__,"xStreamBufferCreate fail");
+			vSemaphoreDelete(ticker->lock);
+			free(ticker);
+			return NULL;
+		}
+	}
+
+	ticker->led = led;
+	ticker->stream = stream;
+	ticker->policy = policy;
+	ticker->step = pdMS_TO_TICKS(step_ms);
+	if (ticker->step == 0) ticker->step = 1;
+	ticker->lag_max = (xStreamBufferBytesAvailable(stream) + xStreamBufferSpacesAvailable(stream)) / 2;
+	ticker->blank = led->segment_max;
+	return ticker;
+}
+
+size_t tm1637_ticker_write(tm1637_ticker_t * ticker, const char * data, size_t length, TickType_t wait)
+{
+	size_t sent = 0;
+	// Without the lock, another writer held the stream for the whole wait
+	if (xSemaphoreTake(ticker->lock, wait) == pdTRUE) {
+		if (ticker->policy != TM1637_TICKER_BLOCK) wait = 0;
+		sent = xStreamBufferSend(ticker->stream, data, length, wait);
+		xSemaphoreGive(ticker->lock);
+	}
+	taskENTER_CRITICAL(&ticker->mux);
+	ticker->dropped += length - sent;
+	taskEXIT_CRITICAL(&ticker->mux);
+	return sent;
+}
+
+void tm1637_ticker_step(tm1637_ticker_t * ticker)
+{
+	int length = ticker->led->segment_max;
+
+	if (ticker->policy == TM1637_TICKER_SKIP_OLD) {
+		char discard[16];
+		size_t lag = xStreamBufferBytesAvailable(ticker->stream);
+		while (lag > ticker->lag_max) {
+			size_t n = lag - ticker->lag_max;
+			if (n > sizeof(discard)) n = sizeof(discard);
+			n = xStreamBufferReceive(ticker->stream, discard, n, 0);
+			if (n == 0) break;
+			ticker->skipped += n;
+			lag -= n;
+		}
+	}
+
+	uint32_t c = tm1637_ticker_next(ticker);
+	if (c == 0) {
+		// No data, scroll out what is shown and then stay blank
+		if (ticker->blank >= length) return;
+		ticker->blank++;
+	} else {
+		ticker->blank = 0;
+	}
+
+	// Oldest glyph leaves on the left, its slot becomes the right digit
+	ticker->window[ticker->head] = (c == 0) ? 0 : tm1637_font_glyph(c);
+	ticker->head = (ticker->head + 1) % length;
+
+	uint8_t frame[6];
+	for (int i=0;i<length;i++) {
+		frame[i] = ticker->window[(ticker->head + i) % length];
+	}
+	tm1637_set_segment_frame(ticker->led, frame);
+}
+
+void tm1637_ticker_task(void * arg)
+{
+	tm1637_ticker_t * ticker = (tm1637_ticker_t *) arg;
+	TickType_t wake = xTaskGetTickCount();
+	while (true) {
+		tm1637_ticker_step(ticker);
+		vTaskDelayUntil(&wake, ticker->step);
+	}
+}
@@ -0,0 +1,88 @@
+/**
+ * ESP-32 IDF library for control TM1637 LED 7-Segment display
+ *
+ * Streaming ticker fed from a FreeRTOS StreamBuffer
+ *
+ * License: MIT (see LICENSE file included)
+ *
+ */
+
+#ifndef TM1637_TICKER_H
+#define TM1637_TICKER_H
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/stream_buffer.h"
+#include "freertos/semphr.h"
+
+#include "tm1637.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	TM1637_TICKER_BLOCK,     // Writer waits for space
+	TM1637_TICKER_DROP_NEW,  // Bytes that do not fit are dropped
+	TM1637_TICKER_SKIP_OLD,  // Display skips ahead when it lags behind by more than lag_max
+} tm1637_ticker_policy_t;
+
+typedef struct {
+	tm1637_led_t * led;
+	StreamBufferHandle_t stream;
+	SemaphoreHandle_t lock;  // Serialises writers, a StreamBuffer takes only one
+	portMUX_TYPE mux;        // Guards dropped
+	tm1637_ticker_policy_t policy;
+	TickType_t step;         // Scroll period
+	size_t lag_max;          // Unread bytes allowed with TM1637_TICKER_SKIP_OLD
+	uint8_t window[6];       // Ring of shown glyphs
+	int head;                // Index of the left digit in window
+	int blank;               // Number of blank glyphs at the right end
+	char utf8[5];            // Partial UTF-8 character
+	int utf8_len;
+	int utf8_need;
+	uint32_t dropped;        // Bytes dropped by tm1637_ticker_write
+	uint32_t skipped;        // Bytes skipped by the display
+} tm1637_ticker_t;
+
+/**
+ * @brief Constructs new ticker object
+ * @param led LED object
+ * @param stream Stream buffer to read, NULL to create one of buffer_size bytes
+ * @param buffer_size Size of created stream buffer
+ * @param step_ms Scroll period
+ * @param policy What happens when the writer outruns the display
+ * @return
+ */
+tm1637_ticker_t * tm1637_ticker_init(tm1637_led_t * led, StreamBufferHandle_t stream, size_t buffer_size, uint32_t step_ms, tm1637_ticker_policy_t policy);
+
+/**
+ * @brief Add UTF-8 text to the ticker. Safe to call from several tasks, not from ISR.
+ * Only an ISR that is the one and only writer may use xStreamBufferSendFromISR on ticker->stream
+ * @param ticker Ticker object
+ * @param data UTF-8 bytes, need not be NUL-terminated
+ * @param length Number of bytes
+ * @param wait Maximum wait for other writers and, with TM1637_TICKER_BLOCK, for space
+ * @return Number of bytes written
+ */
+size_t tm1637_ticker_write(tm1637_ticker_t * ticker, const char * data, size_t length, TickType_t wait);
+
+/**
+ * @brief Scroll one digit. Does not wait for data
+ * @param ticker Ticker object
+ */
+void tm1637_ticker_step(tm1637_ticker_t * ticker);
+
+/**
+ * @brief Task function scrolling the ticker every step. Pass ticker object as arg
+ * @param arg Ticker object
+ */
+void tm1637_ticker_task(void * arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TM1637_TICKER_H
@@ -0,0 +1,51 @@
+/**
+ * @file cpp_example.cpp
+ * @brief Example for the C++ API of the TM1637 LED segment display
+ */
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include "sdkconfig.h"
+#include "tm1637.hpp"
+
+#if CONFIG_TM1637_4_SEGMENT
+constexpr std::size_t LED_DIGITS = 4;
+#else
+constexpr std::size_t LED_DIGITS = 6;
+#endif
+
+#if CONFIG_TM1637_CLOCK_SEGMENT
+constexpr tm1637::Type LED_TYPE = tm1637::Type::Clock;
+#else
+constexpr tm1637::Type LED_TYPE = tm1637::Type::Dot;
+#endif
+
+using Led = tm1637::Display<LED_DIGITS, LED_TYPE>;
+
+// Formatting is done at compile time
+static_assert(Led::format_number(-12, true), "-12 fits on every module");
+static_assert((*Led::format_number(1234, false))[LED_DIGITS-1] == 0x66, "right digit is 4");
+static_assert(!Led::format_number(1234567, false), "7 digits never fit");
+
+extern "C" void tm1637_cpp_example(tm1637_led_t * led)
+{
+	Led display(led);
+
+	display.number(1234); // 1234
+	vTaskDelay(100);
+	display.number(-12, true); // -012
+	vTaskDelay(100);
+#if CONFIG_TM1637_DOT_SEGMENT
+	display.number<0x04>(1234); // 12.34
+	vTaskDelay(100);
+#endif
+#if CONFIG_TM1637_CLOCK_SEGMENT && CONFIG_TM1637_4_SEGMENT
+	display.colon(true);
+	display.number(1234, true); // 12:34
+	vTaskDelay(100);
+	display.colon(false);
+#endif
+	display.text("C++");
+	vTaskDelay(100);
+}
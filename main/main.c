@@ -4,7 +4,9 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
+#include <inttypes.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include <time.h>
@@ -15,17 +17,44 @@
 
 #include "sdkconfig.h"
 #include "tm1637.h"
+#include "tm1637_sched.h"
+#include "tm1637_font.h"
+#include "tm1637_meter.h"
+#include "tm1637_ticker.h"
+#include "tm1637_comp.h"
 
 #define TAG "app"
 
 const gpio_num_t LED_CLK = CONFIG_TM1637_CLK_PIN;
 const gpio_num_t LED_DTA = CONFIG_TM1637_DIO_PIN;
 
+void tm1637_cpp_example(tm1637_led_t * led);
+
 void tm1637_task(void * arg)
 {
-	tm1637_led_t * led = tm1637_init(LED_CLK, LED_DTA);
+	// Same as tm1637_init on cold boot. After deep sleep with tm1637_suspend,
+	// the display is taken over without touching the bus
+	tm1637_led_t * led = tm1637_resume(LED_CLK, LED_DTA);
 	if (led == NULL) vTaskDelete(NULL);
 
+	// 1ms bus time per period, 10ms waiting = 1 priority level
+	tm1637_sched_t * sched = tm1637_sched_init(1, 1000, 10000);
+	if (sched == NULL) vTaskDelete(NULL);
+	int sched_id = tm1637_sched_add(sched, led, 1, 100);
+
+	tm1637_font_register(0x2103, 0x39); // ℃ -> C
+
+	// Full scale 1000, hold peak 300ms, peak falls 50ms per level
+	tm1637_meter_t * meter = tm1637_meter_init(led, TM1637_METER_HORIZONTAL, 1000, 300, 50);
+	if (meter == NULL) vTaskDelete(NULL);
+
+	// 64 byte buffer, 200ms per digit, writer waits for space
+	tm1637_ticker_t * ticker = tm1637_ticker_init(led, NULL, 64, 200, TM1637_TICKER_BLOCK);
+	if (ticker == NULL) vTaskDelete(NULL);
+
+	tm1637_comp_t * comp = tm1637_comp_init(led);
+	if (comp == NULL) vTaskDelete(NULL);
+
 #if 0
 	tm1637_set_brightness(led, 7);
 	while (true) {
@@ -220,6 +249,77 @@ void tm1637_task(void * arg)
 		}
 #endif
 		vTaskDelay(100);
+
+		// Test UTF-8 text
+		tm1637_set_segment_ascii(led, "25°C");
+		vTaskDelay(100);
+		tm1637_set_segment_ascii(led, "-5℃");
+		vTaskDelay(100);
+		tm1637_set_segment_ascii(led, "Temp 25°C Humi 60%");
+		vTaskDelay(100);
+
+		// Test level meter
+		// Input changes every tick, display is written only when the level changes
+		int meter_writes = 0;
+		for (int x=0; x<200; x++) {
+			uint32_t value = (x < 100) ? x * 10 : (200 - x) * 5;
+			if (tm1637_meter_update(meter, value)) meter_writes++;
+			vTaskDelay(1);
+		}
+		ESP_LOGI(TAG, "meter updates=200 writes=%d", meter_writes);
+
+		// Test streaming ticker
+		// Text arrives in pieces while the ticker scrolls
+		char * ticker_text[] = {"TEMP 25°C ", "HUMI 60 ", "PRES 1013 "};
+		for (int x=0; x<3; x++) {
+			tm1637_ticker_write(ticker, ticker_text[x], strlen(ticker_text[x]), portMAX_DELAY);
+			for (int y=0; y<8; y++) {
+				tm1637_ticker_step(ticker);
+				vTaskDelay(pdMS_TO_TICKS(200));
+			}
+		}
+		// Scroll out the rest
+		for (int x=0; x<32; x++) {
+			tm1637_ticker_step(ticker);
+			vTaskDelay(pdMS_TO_TICKS(200));
+		}
+
+		// Test overlay
+		// Alert covers the right 3 digits for 1 second, then the reading comes back
+		uint8_t reading[6] = {0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d}; // 012345
+		uint8_t alert[6] = {0, 0, 0, 0, 0, 0};
+		alert[led->segment_max-3] = 0x79; // E
+		alert[led->segment_max-2] = 0x50; // r
+		alert[led->segment_max-1] = 0x50; // r
+		tm1637_comp_set(comp, TM1637_LAYER_BASE, reading, TM1637_COMP_ALL, 0);
+		vTaskDelay(100);
+		tm1637_comp_set(comp, TM1637_LAYER_ALERT, alert, 0x07, 1000);
+		vTaskDelay(200); // Reading is back after 1 second
+		tm1637_comp_clear(comp, TM1637_LAYER_BASE);
+
+		// Test refresh scheduler
+		// Frames submitted faster than the scheduler runs are replaced by newer ones
+		for (int x=0; x<100; x++) {
+			uint8_t frame[6] = {0,0,0,0,0,0};
+			frame[x % led->segment_max] = 0x40;
+			tm1637_sched_submit(sched, sched_id, frame);
+			if (x % 4 == 0) tm1637_sched_service(sched);
+			vTaskDelay(1);
+		}
+		tm1637_sched_stats_t sched_stats;
+		tm1637_sched_get_stats(sched, sched_id, &sched_stats);
+		ESP_LOGI(TAG, "sched sent=%"PRIu32" superseded=%"PRIu32" latency avg=%"PRIu32"us max=%"PRIu32"us",
+			sched_stats.sent, sched_stats.superseded, sched_stats.latency_avg_us, sched_stats.latency_max_us);
+		tm1637_sched_reset_stats(sched, sched_id);
+
+		// Test C++ API
+		tm1637_cpp_example(led);
+
+#if CONFIG_TM1637_STATS
+		// Bus traffic and latency of one loop
+		tm1637_dump_stats(led);
+		tm1637_reset_stats(led);
+#endif
 	} // end while
 }
 